@@ -30,11 +30,11 @@
 
 #include "jems.h"
 
-#include <inttypes.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 // *****************************************************************************
 // Private types and definitions
@@ -42,6 +42,76 @@
 // *****************************************************************************
 // Private (static) storage
 
+// Two ASCII digits for each value 0..99, used to render integers two digits
+// at a time without resorting to printf().
+static const char s_digit_pairs[] = "00010203040506070809"
+                                    "10111213141516171819"
+                                    "20212223242526272829"
+                                    "30313233343536373839"
+                                    "40414243444546474849"
+                                    "50515253545556575859"
+                                    "60616263646566676869"
+                                    "70717273747576777879"
+                                    "80818283848586878889"
+                                    "90919293949596979899";
+
+static const uint64_t s_powers_of_ten[] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+#define JEMS_MAX_DECIMALS 19
+
+// The range of timestamps RFC-3339 can represent: 0000-01-01T00:00:00Z to
+// 9999-12-31T23:59:59Z
+#define JEMS_MIN_TIMESTAMP -62167219200LL
+#define JEMS_MAX_TIMESTAMP 253402300799LL
+
+#define JEMS_POOL_NONE 0xffff // marks the end of a pool's free lists
+
+// Use the compiler's atomic builtins where the CAS they need is lock-free,
+// i.e. not a library call (which e.g. newlib does not provide).
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4) &&                             \
+    ((SIZE_MAX == UINT32_MAX) || defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8))
+#define JEMS_ATOMIC_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define JEMS_ATOMIC_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define JEMS_ATOMIC_ADD(p, v) __atomic_add_fetch((p), (v), __ATOMIC_ACQ_REL)
+#define JEMS_ATOMIC_CAS(p, expected, desired)                                  \
+  __atomic_compare_exchange_n((p), (expected), (desired), false,               \
+                              __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+// Without lock-free atomics, pools are not thread-safe.
+#define JEMS_ATOMIC_LOAD(p) (*(p))
+#define JEMS_ATOMIC_STORE(p, v) (*(p) = (v))
+#define JEMS_ATOMIC_ADD(p, v) (*(p) += (v))
+#define JEMS_ATOMIC_CAS(p, expected, desired)                                  \
+  ((*(p) == *(expected)) ? (*(p) = (desired), true)                            \
+                         : (*(expected) = *(p), false))
+#endif
+
+static const char s_hex_digits[] = "0123456789abcdef";
+
+static const char s_base64_alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
 // *****************************************************************************
 // Private (static, forward) declarations
 
@@ -50,11 +120,30 @@ static jems_t *pop_level(jems_t *jems);
 static jems_t *emit_char(jems_t *jems, char ch);
 static jems_t *emit_quoted_byte(jems_t *jems, uint8_t byte);
 static jems_t *emit_string(jems_t *jems, const char *s);
-static jems_t *emit_quoted_string(jems_t *jems, const char *s);
+static jems_t *emit_chars(jems_t *jems, const char *s, size_t n);
 static jems_t *emit_quoted_bytes(jems_t *jems, const uint8_t *bytes,
                                  size_t len);
 static jems_t *commify(jems_t *jems);
+static jems_t *pass_to_sink(jems_t *jems, bool is_commit);
+static jems_t *delta_open(jems_t *jems, jems_delta_t *delta,
+                          const jems_mark_t *start);
+static void delta_member_end(jems_t *jems);
+static uint64_t hash_bytes(const char *bytes, size_t n);
+static void atomic_max(size_t *p, size_t value);
+static uint32_t *next_ref(uint32_t *first_next, size_t stride, uint32_t idx);
+static uint32_t freelist_pop(uint32_t *head, uint32_t *first_next,
+                             size_t stride);
+static void freelist_push(uint32_t *head, uint32_t *first_next, size_t stride,
+                          uint32_t first, uint32_t last);
+static uint32_t pool_block_pop(jems_pool_t *pool);
+static void pool_sink(const char *bytes, size_t n_bytes, bool is_commit,
+                      uintptr_t arg);
+static uint64_t cache_tick(jems_cache_t *cache);
 static jems_level_t *level_ref(jems_t *jems);
+static size_t count_digits(uint64_t value);
+static void put_digits(char *buf, uint64_t value, size_t width);
+static size_t format_int64(char *buf, int64_t value);
+static void encode_base64(char *out, const uint8_t *in, size_t n);
 
 // *****************************************************************************
 // Public code
@@ -65,16 +154,366 @@ jems_t *jems_init(jems_t *jems, jems_level_t *levels, size_t max_level,
   jems->max_level = max_level;
   jems->writer = writer;
   jems->arg = arg;
+  jems->buf = NULL;
+  jems->buf_size = 0;
+  jems->sink = NULL;
+  jems->sink_arg = 0;
+  jems->delta = NULL;
   return jems_reset(jems);
 }
 
 jems_t *jems_reset(jems_t *jems) {
+  jems->delta = NULL;
+  jems->buf_len = 0;
+  jems->committed = 0;
   jems->curr_level = 0;
   level_ref(jems)->item_count = 0;
   level_ref(jems)->is_object = false;
   return jems;
 }
 
+jems_t *jems_set_buffer(jems_t *jems, char *buf, size_t buf_size) {
+  jems->buf = buf;
+  jems->buf_size = buf_size;
+  jems->buf_len = 0;
+  jems->committed = 0;
+  jems->sink = NULL;
+  return jems;
+}
+
+jems_t *jems_set_sink(jems_t *jems, char *buf, size_t buf_size,
+                      jems_sink_fn sink, uintptr_t arg) {
+  jems_set_buffer(jems, buf, buf_size);
+  jems->sink = sink;
+  jems->sink_arg = arg;
+  return jems;
+}
+
+size_t jems_buffer_length(jems_t *jems) { return jems->buf_len; }
+
+size_t jems_committed_length(jems_t *jems) { return jems->committed; }
+
+jems_t *jems_mark(jems_t *jems, jems_mark_t *mark) {
+  mark->buf_len = jems->buf_len;
+  mark->committed = jems->committed;
+  mark->curr_level = jems->curr_level;
+  mark->item_count = level_ref(jems)->item_count;
+  return jems;
+}
+
+jems_t *jems_rollback(jems_t *jems, const jems_mark_t *mark) {
+  if (mark->committed != jems->committed) {
+    // the output since the mark has already been passed on
+    return jems;
+  }
+  // Levels below the mark are untouched so long as the mark's own level is
+  // still open, and levels above it will be re-initialized when next pushed.
+  jems->buf_len = mark->buf_len;
+  jems->curr_level = mark->curr_level;
+  level_ref(jems)->item_count = mark->item_count;
+  return jems;
+}
+
+jems_t *jems_commit(jems_t *jems) {
+  if (jems->sink) {
+    return pass_to_sink(jems, true);
+  }
+  size_t n = (jems->buf_len < jems->buf_size) ? jems->buf_len : jems->buf_size;
+  if (jems->writer) {
+    for (size_t i = 0; i < n; i++) {
+      jems->writer(jems->buf[i], jems->arg);
+    }
+  }
+  jems->committed += n;
+  jems->buf_len = 0;
+  return jems;
+}
+
+jems_delta_t *jems_delta_init(jems_delta_t *delta,
+                              jems_delta_entry_t *entries,
+                              size_t capacity) {
+  memset(entries, 0, capacity * sizeof(jems_delta_entry_t));
+  delta->entries = entries;
+  delta->capacity = capacity;
+  delta->parent = NULL;
+  delta->n_changed = 0;
+  return delta;
+}
+
+jems_t *jems_delta_open(jems_t *jems, jems_delta_t *delta) {
+  jems_mark_t start;
+  jems_mark(jems, &start);
+  return delta_open(jems, delta, &start);
+}
+
+jems_t *jems_key_delta_open(jems_t *jems, const char *key,
+                            jems_delta_t *delta) {
+  return jems_key_delta_open_n(jems, key, strlen(key), delta);
+}
+
+jems_t *jems_key_delta_open_n(jems_t *jems, const char *key, size_t key_len,
+                              jems_delta_t *delta) {
+  jems_mark_t start;
+  jems_mark(jems, &start);
+  jems_string_n(jems, key, key_len);
+  if (jems->delta && (jems->curr_level == jems->delta->level)) {
+    // The enclosing delta object may have just rolled back its previous
+    // key:value pair, but has marked the start of this one.
+    start = jems->delta->member;
+  }
+  return delta_open(jems, delta, &start);
+}
+
+jems_t *jems_delta_close(jems_t *jems) {
+  jems_delta_t *delta = jems->delta;
+  if (jems_item_count(jems) > 0) {
+    delta_member_end(jems);
+  }
+  jems->delta = delta->parent;
+  jems_object_close(jems);
+  if (delta->n_changed == 0) {
+    // Roll back to the start, unless that would leave a dangling key.
+    bool is_value = level_ref(jems)->is_object && (delta->start.item_count & 1);
+    if (!is_value) {
+      jems_rollback(jems, &delta->start);
+    }
+  }
+  return jems;
+}
+
+jems_delta_t *jems_delta_accept(jems_delta_t *delta) {
+  for (size_t i = 0; i < delta->capacity; i++) {
+    jems_delta_entry_t *entry = &delta->entries[i];
+    if (entry->pending_hash != 0) {
+      entry->value_hash = entry->pending_hash;
+      entry->pending_hash = 0;
+    }
+  }
+  return delta;
+}
+
+size_t jems_delta_changed(jems_delta_t *delta) { return delta->n_changed; }
+
+jems_pool_t *jems_pool_init(jems_pool_t *pool,
+                            jems_pool_entry_t *entries,
+                            size_t n_entries,
+                            jems_level_t *levels,
+                            size_t max_level,
+                            jems_pool_block_t *blocks,
+                            char *storage,
+                            size_t n_blocks,
+                            size_t block_size) {
+  for (size_t i = 0; i < n_entries; i++) {
+    entries[i].pool = pool;
+    jems_init(&entries[i].jems, &levels[i * max_level], max_level, NULL, 0);
+    entries[i].next = (i + 1 < n_entries) ? i + 1 : JEMS_POOL_NONE;
+  }
+  for (size_t i = 0; i < n_blocks; i++) {
+    blocks[i].next = (i + 1 < n_blocks) ? i + 1 : JEMS_POOL_NONE;
+    blocks[i].length = 0;
+  }
+  pool->entries = entries;
+  pool->n_entries = n_entries;
+  pool->free_head = (n_entries > 0) ? 0 : JEMS_POOL_NONE;
+  pool->blocks = blocks;
+  pool->storage = storage;
+  pool->n_blocks = n_blocks;
+  pool->block_size = block_size;
+  pool->free_block_head = (n_blocks > 0) ? 0 : JEMS_POOL_NONE;
+  pool->n_in_use = 0;
+  pool->max_in_use = 0;
+  pool->n_blocks_in_use = 0;
+  pool->max_blocks_in_use = 0;
+  pool->max_length = 0;
+  return pool;
+}
+
+jems_t *jems_pool_acquire(jems_pool_t *pool) {
+  uint32_t idx = freelist_pop(&pool->free_head, &pool->entries[0].next,
+                              sizeof(jems_pool_entry_t));
+  if (idx == JEMS_POOL_NONE) {
+    return NULL;
+  }
+  jems_pool_entry_t *entry = &pool->entries[idx];
+  uint32_t block = pool_block_pop(pool);
+  if (block == JEMS_POOL_NONE) {
+    freelist_push(&pool->free_head, &pool->entries[0].next,
+                  sizeof(jems_pool_entry_t), idx, idx);
+    return NULL;
+  }
+  atomic_max(&pool->max_in_use, JEMS_ATOMIC_ADD(&pool->n_in_use, 1));
+  entry->first_block = JEMS_POOL_NONE;
+  entry->last_block = JEMS_POOL_NONE;
+  entry->curr_block = block;
+  entry->n_blocks = 1;
+  entry->is_truncated = false;
+  // Undo anything the previous holder may have changed.
+  jems_t *jems = &entry->jems;
+  jems_init(jems, jems->levels, jems->max_level, NULL, 0);
+  return jems_set_sink(jems, &pool->storage[block * pool->block_size],
+                       pool->block_size, pool_sink, (uintptr_t)entry);
+}
+
+size_t jems_pool_output(jems_pool_t *pool, jems_t *jems, jems_sink_fn sink,
+                        uintptr_t arg) {
+  jems_pool_entry_t *entry = (jems_pool_entry_t *)jems;
+  size_t n_bytes = 0;
+  for (uint32_t idx = entry->first_block; idx != JEMS_POOL_NONE;
+       idx = pool->blocks[idx].next) {
+    size_t length = pool->blocks[idx].length;
+    sink(&pool->storage[idx * pool->block_size], length, false, arg);
+    n_bytes += length;
+    if (idx == entry->last_block) {
+      break;
+    }
+  }
+  // The remainder is in the current block, unless the output was cut short.
+  size_t length = entry->is_truncated ? 0 : jems->buf_len;
+  sink(jems->buf, length, true, arg);
+  return n_bytes + length;
+}
+
+bool jems_pool_is_truncated(jems_pool_t *pool, jems_t *jems) {
+  (void)pool;
+  return ((jems_pool_entry_t *)jems)->is_truncated;
+}
+
+void jems_pool_release(jems_pool_t *pool, jems_t *jems) {
+  jems_pool_entry_t *entry = (jems_pool_entry_t *)jems;
+  uint32_t idx = entry - pool->entries;
+  atomic_max(&pool->max_length,
+             jems_committed_length(jems) + jems_buffer_length(jems));
+  // Return the chained blocks and the current block in a single push.
+  uint32_t first = entry->curr_block;
+  if (entry->first_block != JEMS_POOL_NONE) {
+    JEMS_ATOMIC_STORE(&pool->blocks[entry->last_block].next,
+                      entry->curr_block);
+    first = entry->first_block;
+  }
+  JEMS_ATOMIC_ADD(&pool->n_blocks_in_use, -entry->n_blocks);
+  freelist_push(&pool->free_block_head, &pool->blocks[0].next,
+                sizeof(jems_pool_block_t), first, entry->curr_block);
+  JEMS_ATOMIC_ADD(&pool->n_in_use, -1);
+  freelist_push(&pool->free_head, &pool->entries[0].next,
+                sizeof(jems_pool_entry_t), idx, idx);
+}
+
+size_t jems_pool_in_use(jems_pool_t *pool) {
+  return JEMS_ATOMIC_LOAD(&pool->n_in_use);
+}
+
+size_t jems_pool_max_in_use(jems_pool_t *pool) {
+  return JEMS_ATOMIC_LOAD(&pool->max_in_use);
+}
+
+size_t jems_pool_blocks_in_use(jems_pool_t *pool) {
+  return JEMS_ATOMIC_LOAD(&pool->n_blocks_in_use);
+}
+
+size_t jems_pool_max_blocks_in_use(jems_pool_t *pool) {
+  return JEMS_ATOMIC_LOAD(&pool->max_blocks_in_use);
+}
+
+size_t jems_pool_max_length(jems_pool_t *pool) {
+  return JEMS_ATOMIC_LOAD(&pool->max_length);
+}
+
+jems_cache_t *jems_cache_init(jems_cache_t *cache,
+                              jems_cache_entry_t *entries,
+                              size_t n_entries,
+                              char *storage,
+                              size_t slot_size) {
+  memset(entries, 0, n_entries * sizeof(jems_cache_entry_t));
+  cache->entries = entries;
+  cache->n_entries = n_entries;
+  cache->storage = storage;
+  cache->slot_size = slot_size;
+  cache->clock = 0;
+  cache->depth = 0;
+  return cache;
+}
+
+bool jems_cached_begin(jems_t *jems, jems_cache_t *cache, uint32_t id,
+                       uint32_t version) {
+  // A delta object discards unchanged key:value pairs from the buffer, so
+  // fragments at its level can neither be replayed nor recorded.
+  bool is_delta = jems->delta && (jems->curr_level == jems->delta->level);
+  for (size_t i = 0; (i < cache->n_entries) && !is_delta; i++) {
+    jems_cache_entry_t *entry = &cache->entries[i];
+    if ((entry->last_used != 0) && (entry->id == id) &&
+        (entry->version == version)) {
+      // hit: splice in the fragment, accounting for all of its items
+      entry->last_used = cache_tick(cache);
+      if (entry->item_count > 0) {
+        commify(jems);
+        emit_chars(jems, &cache->storage[i * cache->slot_size], entry->length);
+        level_ref(jems)->item_count += entry->item_count - 1;
+      }
+      return true;
+    }
+  }
+  // miss: note where the fragment starts, nesting permitting
+  if ((cache->depth < JEMS_CACHE_MAX_NESTING) && !is_delta) {
+    jems_cache_pending_t *pending = &cache->pending[cache->depth];
+    pending->id = id;
+    pending->version = version;
+    pending->is_recording = true;
+    jems_mark(jems, &pending->start);
+  } else if (cache->depth < JEMS_CACHE_MAX_NESTING) {
+    cache->pending[cache->depth].is_recording = false;
+  }
+  cache->depth += 1;
+  return false;
+}
+
+jems_t *jems_cached_end(jems_t *jems, jems_cache_t *cache) {
+  cache->depth -= 1;
+  if (cache->depth >= JEMS_CACHE_MAX_NESTING) {
+    return jems; // nested too deeply to have been recorded
+  }
+  jems_cache_pending_t *pending = &cache->pending[cache->depth];
+  jems_mark_t *start = &pending->start;
+  if (!pending->is_recording || (jems->buf == NULL) ||
+      (jems->buf_len > jems->buf_size) ||
+      (jems->committed != start->committed) ||
+      (jems->curr_level != start->curr_level)) {
+    return jems;
+  }
+  size_t item_count = level_ref(jems)->item_count - start->item_count;
+  size_t offset = start->buf_len;
+  if ((item_count > 0) && (start->item_count > 0)) {
+    offset += 1; // skip the separator emitted ahead of the first item
+  }
+  size_t length = jems->buf_len - offset;
+  if (length > cache->slot_size) {
+    return jems;
+  }
+  // Only now that the fragment is known to be good, replace any stale version
+  // of it, else an unused entry, else the least recently used one.
+  jems_cache_entry_t *victim = NULL;
+  for (size_t i = 0; i < cache->n_entries; i++) {
+    jems_cache_entry_t *entry = &cache->entries[i];
+    if ((entry->last_used != 0) && (entry->id == pending->id)) {
+      victim = entry;
+      break;
+    }
+    if ((victim == NULL) || (entry->last_used < victim->last_used)) {
+      victim = entry;
+    }
+  }
+  if (victim == NULL) {
+    return jems;
+  }
+  size_t slot = victim - cache->entries;
+  memcpy(&cache->storage[slot * cache->slot_size], &jems->buf[offset], length);
+  victim->id = pending->id;
+  victim->version = pending->version;
+  victim->length = length;
+  victim->item_count = item_count;
+  victim->last_used = cache_tick(cache);
+  return jems;
+}
+
 jems_t *jems_object_open(jems_t *jems) {
   commify(jems);
   emit_char(jems, '{');
@@ -102,32 +541,83 @@ jems_t *jems_number(jems_t *jems, double value) {
   int64_t i = value;
   if ((double)i == value) {
     // if number can be represented exactly as an int, print as int
-    snprintf(buf, sizeof(buf), "%" PRId64, i);
-  } else {
-    snprintf(buf, sizeof(buf), "%lf", value);
+    return jems_integer(jems, i);
   }
+  snprintf(buf, sizeof(buf), "%lf", value);
   commify(jems);
   return emit_string(jems, buf);
 }
 
 jems_t *jems_integer(jems_t *jems, int64_t value) {
-  char buf[22]; // 20 digits, 1 sign, 1 null
-  snprintf(buf, sizeof(buf), "%" PRId64, value);
+  char buf[21]; // 20 digits, 1 sign
+  size_t n = format_int64(buf, value);
   commify(jems);
-  return emit_string(jems, buf);
+  return emit_chars(jems, buf, n);
 }
 
 jems_t *jems_string(jems_t *jems, const char *string) {
+  return jems_string_n(jems, string, strlen(string));
+}
+
+jems_t *jems_string_n(jems_t *jems, const char *string, size_t length) {
   commify(jems);
   emit_char(jems, '"');
-  emit_quoted_string(jems, string);
+  emit_quoted_bytes(jems, (const uint8_t *)string, length);
   return emit_char(jems, '"');
 }
 
 jems_t *jems_bytes(jems_t *jems, const uint8_t *bytes, size_t length) {
+  return jems_string_n(jems, (const char *)bytes, length);
+}
+
+jems_t *jems_string_begin(jems_t *jems) {
   commify(jems);
-  emit_char(jems, '"');
-  emit_quoted_bytes(jems, bytes, length);
+  return emit_char(jems, '"');
+}
+
+jems_t *jems_string_append(jems_t *jems, const char *string, size_t length) {
+  return emit_quoted_bytes(jems, (const uint8_t *)string, length);
+}
+
+jems_t *jems_string_end(jems_t *jems) { return emit_char(jems, '"'); }
+
+jems_t *jems_base64(jems_t *jems, const uint8_t *bytes, size_t length) {
+  jems_base64_begin(jems);
+  jems_base64_append(jems, bytes, length);
+  return jems_base64_end(jems);
+}
+
+jems_t *jems_base64_begin(jems_t *jems) {
+  jems->b64_n_pending = 0;
+  commify(jems);
+  return emit_char(jems, '"');
+}
+
+jems_t *jems_base64_append(jems_t *jems, const uint8_t *bytes, size_t length) {
+  char out[64]; // encode in batches to amortize emit overhead
+  size_t n_out = 0;
+  for (size_t i = 0; i < length; i++) {
+    jems->b64_pending[jems->b64_n_pending++] = bytes[i];
+    if (jems->b64_n_pending == 3) {
+      encode_base64(&out[n_out], jems->b64_pending, 3);
+      jems->b64_n_pending = 0;
+      n_out += 4;
+      if (n_out == sizeof(out)) {
+        emit_chars(jems, out, n_out);
+        n_out = 0;
+      }
+    }
+  }
+  return emit_chars(jems, out, n_out);
+}
+
+jems_t *jems_base64_end(jems_t *jems) {
+  if (jems->b64_n_pending > 0) {
+    char out[4];
+    encode_base64(out, jems->b64_pending, jems->b64_n_pending);
+    jems->b64_n_pending = 0;
+    emit_chars(jems, out, sizeof(out));
+  }
   return emit_char(jems, '"');
 }
 
@@ -160,6 +650,134 @@ jems_t *jems_literal(jems_t *jems, const char *literal, size_t n_bytes) {
   return jems;
 }
 
+jems_t *jems_fixed(jems_t *jems, int64_t value, unsigned int decimals) {
+  char buf[22]; // 1 sign, 20 digits, 1 decimal point
+  char *p = buf;
+  uint64_t magnitude = (value < 0) ? 0 - (uint64_t)value : (uint64_t)value;
+
+  if (decimals > JEMS_MAX_DECIMALS) {
+    // |value| < 10^20, so it is all fraction: emit it as 20 digits preceded
+    // by as many zeros as needed.
+    commify(jems);
+    emit_string(jems, (value < 0) ? "-0." : "0.");
+    for (unsigned int i = 20; i < decimals; i++) {
+      emit_char(jems, '0');
+    }
+    put_digits(buf, magnitude, 20);
+    return emit_chars(jems, buf, 20);
+  }
+  if (value < 0) {
+    *p++ = '-';
+  }
+  uint64_t scale = s_powers_of_ten[decimals];
+  uint64_t whole = magnitude / scale;
+  size_t n = count_digits(whole);
+  put_digits(p, whole, n);
+  p += n;
+  if (decimals > 0) {
+    *p++ = '.';
+    put_digits(p, magnitude % scale, decimals);
+    p += decimals;
+  }
+  commify(jems);
+  return emit_chars(jems, buf, p - buf);
+}
+
+jems_t *jems_timestamp(jems_t *jems, int64_t seconds, uint32_t nanoseconds) {
+  char buf[32]; // "YYYY-MM-DDTHH:MM:SS.nnnnnnnnnZ"
+  char *p = buf;
+  if ((seconds < JEMS_MIN_TIMESTAMP) || (seconds > JEMS_MAX_TIMESTAMP) ||
+      (nanoseconds > 999999999)) {
+    return jems_null(jems);
+  }
+  int64_t days = seconds / 86400;
+  int64_t secs = seconds % 86400;
+  if (secs < 0) {
+    secs += 86400;
+    days -= 1;
+  }
+
+  // Convert days since epoch to year / month / day in the proleptic Gregorian
+  // calendar.  See http://howardhinnant.github.io/date_algorithms.html
+  days += 719468;
+  int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  uint32_t doe = (uint32_t)(days - era * 146097);
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  uint32_t mp = (5 * doy + 2) / 153;
+  uint32_t day = doy - (153 * mp + 2) / 5 + 1;
+  uint32_t month = (mp < 10) ? mp + 3 : mp - 9;
+  int64_t year = (int64_t)yoe + era * 400 + (month <= 2);
+
+  *p++ = '"';
+  put_digits(p, (uint64_t)year, 4);
+  p += 4;
+  *p++ = '-';
+  put_digits(p, month, 2);
+  p += 2;
+  *p++ = '-';
+  put_digits(p, day, 2);
+  p += 2;
+  *p++ = 'T';
+  put_digits(p, secs / 3600, 2);
+  p += 2;
+  *p++ = ':';
+  put_digits(p, (secs / 60) % 60, 2);
+  p += 2;
+  *p++ = ':';
+  put_digits(p, secs % 60, 2);
+  p += 2;
+  if (nanoseconds != 0) {
+    // emit milli-, micro- or nanoseconds, whichever is exact
+    *p++ = '.';
+    if (nanoseconds % 1000000 == 0) {
+      put_digits(p, nanoseconds / 1000000, 3);
+      p += 3;
+    } else if (nanoseconds % 1000 == 0) {
+      put_digits(p, nanoseconds / 1000, 6);
+      p += 6;
+    } else {
+      put_digits(p, nanoseconds, 9);
+      p += 9;
+    }
+  }
+  *p++ = 'Z';
+  *p++ = '"';
+  commify(jems);
+  return emit_chars(jems, buf, p - buf);
+}
+
+jems_t *jems_slot_integer(jems_t *jems, jems_slot_t *slot, int64_t value,
+                          size_t width) {
+  char buf[21];
+  size_t n = format_int64(buf, value);
+  if (width < n) {
+    width = n;
+  }
+  commify(jems);
+  if (jems->buf && (jems->buf_len + width <= jems->buf_size)) {
+    slot->ptr = &jems->buf[jems->buf_len];
+  } else {
+    slot->ptr = NULL;
+  }
+  slot->width = width;
+  for (size_t i = n; i < width; i++) {
+    emit_char(jems, ' ');
+  }
+  return emit_chars(jems, buf, n);
+}
+
+bool jems_slot_set_integer(jems_slot_t *slot, int64_t value) {
+  char buf[21];
+  size_t n = format_int64(buf, value);
+  if ((slot->ptr == NULL) || (n > slot->width)) {
+    return false;
+  }
+  memset(slot->ptr, ' ', slot->width - n);
+  memcpy(&slot->ptr[slot->width - n], buf, n);
+  return true;
+}
+
 // ***************
 // key:value pairs
 
@@ -188,6 +806,19 @@ jems_t *jems_key_bytes(jems_t *jems, const char *key, const uint8_t *bytes,
   return jems_bytes(jems_string(jems, key), bytes, length);
 }
 
+jems_t *jems_key_string_begin(jems_t *jems, const char *key) {
+  return jems_string_begin(jems_string(jems, key));
+}
+
+jems_t *jems_key_base64(jems_t *jems, const char *key, const uint8_t *bytes,
+                        size_t length) {
+  return jems_base64(jems_string(jems, key), bytes, length);
+}
+
+jems_t *jems_key_base64_begin(jems_t *jems, const char *key) {
+  return jems_base64_begin(jems_string(jems, key));
+}
+
 jems_t *jems_key_bool(jems_t *jems, const char *key, bool boolean) {
   return jems_bool(jems_string(jems, key), boolean);
 }
@@ -209,6 +840,102 @@ jems_t *jems_key_literal(jems_t *jems, const char *key, const char *literal,
   return jems_literal(jems_string(jems, key), literal, n_bytes);
 }
 
+jems_t *jems_key_fixed(jems_t *jems, const char *key, int64_t value,
+                       unsigned int decimals) {
+  return jems_fixed(jems_string(jems, key), value, decimals);
+}
+
+jems_t *jems_key_timestamp(jems_t *jems, const char *key, int64_t seconds,
+                           uint32_t nanoseconds) {
+  return jems_timestamp(jems_string(jems, key), seconds, nanoseconds);
+}
+
+jems_t *jems_key_slot_integer(jems_t *jems, const char *key, jems_slot_t *slot,
+                              int64_t value, size_t width) {
+  return jems_slot_integer(jems_string(jems, key), slot, value, width);
+}
+
+jems_t *jems_key_object_open_n(jems_t *jems, const char *key, size_t key_len) {
+  return jems_object_open(jems_string_n(jems, key, key_len));
+}
+
+jems_t *jems_key_array_open_n(jems_t *jems, const char *key, size_t key_len) {
+  return jems_array_open(jems_string_n(jems, key, key_len));
+}
+
+jems_t *jems_key_number_n(jems_t *jems, const char *key, size_t key_len,
+                          double value) {
+  return jems_number(jems_string_n(jems, key, key_len), value);
+}
+
+jems_t *jems_key_integer_n(jems_t *jems, const char *key, size_t key_len,
+                           int64_t value) {
+  return jems_integer(jems_string_n(jems, key, key_len), value);
+}
+
+jems_t *jems_key_string_n(jems_t *jems, const char *key, size_t key_len,
+                          const char *string, size_t length) {
+  return jems_string_n(jems_string_n(jems, key, key_len), string, length);
+}
+
+jems_t *jems_key_bytes_n(jems_t *jems, const char *key, size_t key_len,
+                         const uint8_t *bytes, size_t length) {
+  return jems_bytes(jems_string_n(jems, key, key_len), bytes, length);
+}
+
+jems_t *jems_key_string_begin_n(jems_t *jems, const char *key, size_t key_len) {
+  return jems_string_begin(jems_string_n(jems, key, key_len));
+}
+
+jems_t *jems_key_base64_n(jems_t *jems, const char *key, size_t key_len,
+                          const uint8_t *bytes, size_t length) {
+  return jems_base64(jems_string_n(jems, key, key_len), bytes, length);
+}
+
+jems_t *jems_key_base64_begin_n(jems_t *jems, const char *key, size_t key_len) {
+  return jems_base64_begin(jems_string_n(jems, key, key_len));
+}
+
+jems_t *jems_key_bool_n(jems_t *jems, const char *key, size_t key_len,
+                        bool boolean) {
+  return jems_bool(jems_string_n(jems, key, key_len), boolean);
+}
+
+jems_t *jems_key_true_n(jems_t *jems, const char *key, size_t key_len) {
+  return jems_true(jems_string_n(jems, key, key_len));
+}
+
+jems_t *jems_key_false_n(jems_t *jems, const char *key, size_t key_len) {
+  return jems_false(jems_string_n(jems, key, key_len));
+}
+
+jems_t *jems_key_null_n(jems_t *jems, const char *key, size_t key_len) {
+  return jems_null(jems_string_n(jems, key, key_len));
+}
+
+jems_t *jems_key_literal_n(jems_t *jems, const char *key, size_t key_len,
+                           const char *literal, size_t n_bytes) {
+  return jems_literal(jems_string_n(jems, key, key_len), literal, n_bytes);
+}
+
+jems_t *jems_key_fixed_n(jems_t *jems, const char *key, size_t key_len,
+                         int64_t value, unsigned int decimals) {
+  return jems_fixed(jems_string_n(jems, key, key_len), value, decimals);
+}
+
+jems_t *jems_key_timestamp_n(jems_t *jems, const char *key, size_t key_len,
+                             int64_t seconds, uint32_t nanoseconds) {
+  return jems_timestamp(
+      jems_string_n(jems, key, key_len), seconds, nanoseconds);
+}
+
+jems_t *jems_key_slot_integer_n(jems_t *jems, const char *key, size_t key_len,
+                                jems_slot_t *slot, int64_t value,
+                                size_t width) {
+  return jems_slot_integer(
+      jems_string_n(jems, key, key_len), slot, value, width);
+}
+
 size_t jems_curr_level(jems_t *jems) { return jems->curr_level; }
 
 size_t jems_item_count(jems_t *jems) { return level_ref(jems)->item_count; }
@@ -233,15 +960,26 @@ static jems_t *pop_level(jems_t *jems) {
 }
 
 static jems_t *emit_char(jems_t *jems, char ch) {
-  jems->writer(ch, jems->arg);
+  if (jems->buf) {
+    if (jems->sink && (jems->buf_len == jems->buf_size)) {
+      pass_to_sink(jems, false);
+    }
+    if (jems->buf_len < jems->buf_size) {
+      jems->buf[jems->buf_len] = ch;
+    }
+    jems->buf_len += 1;
+  } else {
+    jems->writer(ch, jems->arg);
+  }
   return jems;
 }
 
 static jems_t *emit_quoted_byte(jems_t *jems, uint8_t byte) {
   if ((byte < 0x20) || (byte >= 127)) {
-    char buf[7];
-    sprintf(buf, "\\u%04x", byte);
-    emit_string(jems, buf);
+    char buf[6] = {'\\', 'u', '0', '0'};
+    buf[4] = s_hex_digits[byte >> 4];
+    buf[5] = s_hex_digits[byte & 0x0f];
+    emit_chars(jems, buf, sizeof(buf));
   } else {
     if ((byte == '\\') || (byte == '"')) {
       emit_char(jems, '\\');
@@ -258,24 +996,57 @@ static jems_t *emit_string(jems_t *jems, const char *s) {
   return jems;
 }
 
-static jems_t *emit_quoted_string(jems_t *jems, const char *s) {
-  while (*s) {
-    emit_quoted_byte(jems, (uint8_t)(*s++));
+static jems_t *emit_chars(jems_t *jems, const char *s, size_t n) {
+  if (jems->buf) {
+    // with a sink, fill and pass on the buffer until the remainder fits
+    while (jems->sink && (jems->buf_len + n > jems->buf_size)) {
+      size_t avail = jems->buf_size - jems->buf_len;
+      memcpy(&jems->buf[jems->buf_len], s, avail);
+      jems->buf_len += avail;
+      s += avail;
+      n -= avail;
+      pass_to_sink(jems, false);
+    }
+    // copy as much as fits in one go, count the rest as overflow
+    if (jems->buf_len < jems->buf_size) {
+      size_t avail = jems->buf_size - jems->buf_len;
+      memcpy(&jems->buf[jems->buf_len], s, (n < avail) ? n : avail);
+    }
+    jems->buf_len += n;
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      emit_char(jems, s[i]);
+    }
   }
   return jems;
 }
 
 static jems_t *emit_quoted_bytes(jems_t *jems, const uint8_t *bytes,
                                  size_t len) {
-  for (int i = 0; i < len; i++) {
+  // Emit runs of bytes that need no quoting as a single block, quoting the
+  // others one at a time.
+  size_t run = 0;
+  for (size_t i = 0; i < len; i++) {
     const uint8_t b = bytes[i];
-    emit_quoted_byte(jems, b);
+    if ((b < 0x20) || (b >= 127) || (b == '\\') || (b == '"')) {
+      emit_chars(jems, (const char *)&bytes[run], i - run);
+      emit_quoted_byte(jems, b);
+      run = i + 1;
+    }
   }
-  return jems;
+  return emit_chars(jems, (const char *)&bytes[run], len - run);
 }
 
 static jems_t *commify(jems_t *jems) {
   jems_level_t *level = level_ref(jems);
+  bool is_delta = jems->delta && (jems->curr_level == jems->delta->level);
+  if (is_delta && !(level->item_count & 1)) {
+    // starting a new key: decide the fate of the previous key:value pair
+    if (level->item_count > 0) {
+      delta_member_end(jems);
+    }
+    jems_mark(jems, &jems->delta->member);
+  }
   size_t count = level->item_count;
   if (level->is_object) {
     // within { ... }:
@@ -294,12 +1065,243 @@ static jems_t *commify(jems_t *jems) {
     }
   }
   level->item_count += 1;
+  if (is_delta && (count & 1)) {
+    jems->delta->value_start = jems->buf_len;
+  }
   return jems;
 }
 
+static jems_t *pass_to_sink(jems_t *jems, bool is_commit) {
+  // with a sink, buf_len never exceeds buf_size
+  jems->sink(jems->buf, jems->buf_len, is_commit, jems->sink_arg);
+  jems->committed += jems->buf_len;
+  jems->buf_len = 0;
+  return jems;
+}
+
+static jems_t *delta_open(jems_t *jems, jems_delta_t *delta,
+                          const jems_mark_t *start) {
+  // forget values emitted by a previous patch that was never accepted
+  for (size_t i = 0; i < delta->capacity; i++) {
+    delta->entries[i].pending_hash = 0;
+  }
+  delta->start = *start;
+  jems_object_open(jems);
+  delta->level = jems->curr_level;
+  delta->n_changed = 0;
+  delta->parent = jems->delta;
+  jems->delta = delta;
+  return jems;
+}
+
+// Called at the end of each key:value pair in a delta object: discard the pair
+// if its value hasn't changed since the last accepted emission.
+static void delta_member_end(jems_t *jems) {
+  jems_delta_t *delta = jems->delta;
+  if ((jems->buf_len == delta->member.buf_len) &&
+      (jems->committed == delta->member.committed)) {
+    // nothing left of the pair, e.g. a nested delta object that was unchanged
+    return;
+  }
+  size_t key_start = delta->member.buf_len;
+  if (delta->member.item_count > 0) {
+    key_start += 1; // skip the ','
+  }
+  if ((jems->buf_len > jems->buf_size) ||
+      (jems->committed != delta->member.committed) ||
+      (key_start >= delta->value_start) ||
+      (delta->value_start > jems->buf_len)) {
+    // truncated or already passed on: can't be compared, so assume it changed
+    delta->n_changed += 1;
+    return;
+  }
+  uint64_t key_hash = hash_bytes(&jems->buf[key_start],
+                                 delta->value_start - 1 - key_start);
+  uint64_t value_hash = hash_bytes(&jems->buf[delta->value_start],
+                                   jems->buf_len - delta->value_start);
+  // 0 is reserved for unused entries and missing values
+  if (key_hash == 0) {
+    key_hash = 1;
+  }
+  if (value_hash == 0) {
+    value_hash = 1;
+  }
+  // open addressing with linear probing
+  size_t idx = key_hash % delta->capacity;
+  for (size_t i = 0; i < delta->capacity; i++) {
+    jems_delta_entry_t *entry = &delta->entries[idx];
+    if (entry->key_hash == key_hash) {
+      if (entry->value_hash == value_hash) {
+        jems_rollback(jems, &delta->member);
+        return;
+      }
+      entry->pending_hash = value_hash;
+      break;
+    } else if (entry->key_hash == 0) {
+      entry->key_hash = key_hash;
+      entry->pending_hash = value_hash;
+      break;
+    }
+    idx = (idx + 1 == delta->capacity) ? 0 : idx + 1;
+  }
+  delta->n_changed += 1;
+}
+
+// 64 bit FNV-1a
+static uint64_t hash_bytes(const char *bytes, size_t n) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < n; i++) {
+    hash ^= (uint8_t)bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static void atomic_max(size_t *p, size_t value) {
+  size_t curr = JEMS_ATOMIC_LOAD(p);
+  while ((value > curr) && !JEMS_ATOMIC_CAS(p, &curr, value)) {
+    // curr has been refreshed: try again
+  }
+}
+
+// Return the next field of element idx of an array of structs.
+static uint32_t *next_ref(uint32_t *first_next, size_t stride, uint32_t idx) {
+  return (uint32_t *)((char *)first_next + idx * stride);
+}
+
+// Pop the head of a free list, or return JEMS_POOL_NONE if it is empty.  The
+// tag in the upper 16 bits of head changes on every update, which guards
+// against the ABA problem.
+static uint32_t freelist_pop(uint32_t *head, uint32_t *first_next,
+                             size_t stride) {
+  uint32_t curr = JEMS_ATOMIC_LOAD(head);
+  do {
+    uint32_t idx = curr & 0xffff;
+    if (idx == JEMS_POOL_NONE) {
+      return idx;
+    }
+    uint32_t tag = ((curr >> 16) + 1) & 0xffff;
+    uint32_t next = JEMS_ATOMIC_LOAD(next_ref(first_next, stride, idx));
+    if (JEMS_ATOMIC_CAS(head, &curr, (tag << 16) | next)) {
+      return idx;
+    }
+  } while (true);
+}
+
+// Push the list of elements from first to last onto the head of a free list.
+static void freelist_push(uint32_t *head, uint32_t *first_next, size_t stride,
+                          uint32_t first, uint32_t last) {
+  uint32_t curr = JEMS_ATOMIC_LOAD(head);
+  do {
+    uint32_t tag = ((curr >> 16) + 1) & 0xffff;
+    JEMS_ATOMIC_STORE(next_ref(first_next, stride, last), curr & 0xffff);
+    if (JEMS_ATOMIC_CAS(head, &curr, (tag << 16) | first)) {
+      return;
+    }
+  } while (true);
+}
+
+static uint32_t pool_block_pop(jems_pool_t *pool) {
+  uint32_t idx = freelist_pop(&pool->free_block_head, &pool->blocks[0].next,
+                              sizeof(jems_pool_block_t));
+  if (idx != JEMS_POOL_NONE) {
+    atomic_max(&pool->max_blocks_in_use,
+               JEMS_ATOMIC_ADD(&pool->n_blocks_in_use, 1));
+  }
+  return idx;
+}
+
+// The sink of a pooled jems object: chain the full block to the object's
+// output and carry on in a fresh one.
+static void pool_sink(const char *bytes, size_t n_bytes, bool is_commit,
+                      uintptr_t arg) {
+  (void)bytes;
+  (void)is_commit;
+  jems_pool_entry_t *entry = (jems_pool_entry_t *)arg;
+  jems_pool_t *pool = entry->pool;
+  if ((n_bytes == 0) || entry->is_truncated) {
+    // nothing to keep, or the output is already cut short: reuse the block
+    return;
+  }
+  uint32_t block = pool_block_pop(pool);
+  if (block == JEMS_POOL_NONE) {
+    entry->is_truncated = true;
+    return;
+  }
+  pool->blocks[entry->curr_block].length = n_bytes;
+  if (entry->first_block == JEMS_POOL_NONE) {
+    entry->first_block = entry->curr_block;
+  } else {
+    // a stale pop may still be reading the next field of a recycled block
+    JEMS_ATOMIC_STORE(&pool->blocks[entry->last_block].next,
+                      entry->curr_block);
+  }
+  entry->last_block = entry->curr_block;
+  entry->curr_block = block;
+  entry->n_blocks += 1;
+  entry->jems.buf = &pool->storage[block * pool->block_size];
+}
+
+static uint64_t cache_tick(jems_cache_t *cache) {
+  // 64 bits won't wrap, and 0 is reserved for unused entries
+  cache->clock += 1;
+  return cache->clock;
+}
+
 static jems_level_t *level_ref(jems_t *jems) {
   return &jems->levels[jems->curr_level];
 }
 
+static size_t count_digits(uint64_t value) {
+  size_t n = 1;
+  while ((n < 20) && (value >= s_powers_of_ten[n])) {
+    n += 1;
+  }
+  return n;
+}
+
+// Render the low-order `width` decimal digits of value into buf[0..width),
+// padding with leading zeros.  No null terminator is written.
+static void put_digits(char *buf, uint64_t value, size_t width) {
+  char *p = buf + width;
+  while (p - buf >= 2) {
+    const char *pair = &s_digit_pairs[(value % 100) * 2];
+    value /= 100;
+    *--p = pair[1];
+    *--p = pair[0];
+  }
+  if (p > buf) {
+    *--p = '0' + (value % 10);
+  }
+}
+
+// Render value into buf (which must hold at least 21 bytes) and return the
+// number of bytes written.  No null terminator is written.
+static size_t format_int64(char *buf, int64_t value) {
+  char *p = buf;
+  uint64_t magnitude = (value < 0) ? 0 - (uint64_t)value : (uint64_t)value;
+  if (value < 0) {
+    *p++ = '-';
+  }
+  size_t n = count_digits(magnitude);
+  put_digits(p, magnitude, n);
+  return (p - buf) + n;
+}
+
+// Encode n (1 to 3) bytes as four base64 characters, padding with '='.
+static void encode_base64(char *out, const uint8_t *in, size_t n) {
+  uint32_t bits = (uint32_t)in[0] << 16;
+  if (n > 1) {
+    bits |= (uint32_t)in[1] << 8;
+  }
+  if (n > 2) {
+    bits |= in[2];
+  }
+  out[0] = s_base64_alphabet[(bits >> 18) & 0x3f];
+  out[1] = s_base64_alphabet[(bits >> 12) & 0x3f];
+  out[2] = (n > 1) ? s_base64_alphabet[(bits >> 6) & 0x3f] : '=';
+  out[3] = (n > 2) ? s_base64_alphabet[bits & 0x3f] : '=';
+}
+
 // *****************************************************************************
 // End of file
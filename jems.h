@@ -56,14 +56,134 @@ typedef struct {
 // Signature for the jems_emit function
 typedef void (*jems_writer_fn)(char ch, uintptr_t arg);
 
+// Signature for a function that accepts a block of buffered output.  is_commit
+// is true when the block ends at a jems_commit() boundary.
+typedef void (*jems_sink_fn)(const char *bytes, size_t n_bytes, bool is_commit,
+                             uintptr_t arg);
+
+struct _jems_delta;
+
 typedef struct _jems {
   jems_level_t *levels;
   size_t max_level;
   size_t curr_level;
   jems_writer_fn writer;
   uintptr_t arg;
+  char *buf;         // if non-NULL, output is written here instead of writer
+  size_t buf_size;   // capacity of buf
+  size_t buf_len;    // # of bytes emitted into buf (may exceed buf_size)
+  jems_sink_fn sink; // if non-NULL, receives buf whenever it fills
+  uintptr_t sink_arg; // user-supplied argument passed to sink
+  size_t committed;  // # of bytes passed on by jems_commit()
+  struct _jems_delta *delta; // if non-NULL, the open delta object
+  uint8_t b64_pending[3]; // bytes awaiting base64 encoding
+  uint8_t b64_n_pending;  // # of bytes in b64_pending
 } jems_t;
 
+// A fixed-width value within a buffered jems object that can be rewritten in
+// place after the fact.
+typedef struct {
+  char *ptr;         // start of the slot in the output buffer, or NULL
+  size_t width;      // # of bytes reserved for the slot
+} jems_slot_t;
+
+// A saved position in a buffered jems object, see jems_mark().
+typedef struct {
+  size_t buf_len;
+  size_t committed;    // jems_committed_length() when the mark was taken
+  size_t curr_level;
+  size_t item_count;
+} jems_mark_t;
+
+// One key of a delta object, see jems_delta_init().
+typedef struct {
+  uint64_t key_hash;     // 0 marks an unused entry
+  uint64_t value_hash;   // last accepted value, 0 if none
+  uint64_t pending_hash; // value awaiting jems_delta_accept(), 0 if none
+} jems_delta_entry_t;
+
+// State for emitting an object as a JSON Merge Patch against its previous
+// emission.
+typedef struct _jems_delta {
+  jems_delta_entry_t *entries;
+  size_t capacity;
+  struct _jems_delta *parent; // enclosing delta object, if any
+  size_t level;        // level of the delta object
+  jems_mark_t start;   // position the object is rolled back to if unchanged
+  jems_mark_t member;  // position before the current key:value pair
+  size_t value_start;  // buffer offset of the current value
+  size_t n_changed;    // # of key:value pairs emitted
+} jems_delta_t;
+
+// One block of the arena shared by a pool's jems objects, see jems_pool_init().
+typedef struct {
+  uint32_t next;       // index of the next free or chained block
+  size_t length;       // # of bytes of output held by a chained block
+} jems_pool_block_t;
+
+struct _jems_pool;
+
+// One pooled jems object, see jems_pool_init().
+typedef struct {
+  jems_t jems;         // must be first
+  struct _jems_pool *pool;
+  uint32_t next;       // index of the next free entry
+  uint32_t first_block; // first filled block of output, if any
+  uint32_t last_block; // last filled block of output, if any
+  uint32_t curr_block; // block being filled
+  size_t n_blocks;     // # of blocks held, including curr_block
+  bool is_truncated;   // true if the arena ran out of blocks
+} jems_pool_entry_t;
+
+// A pool of buffered jems objects that may be shared among threads.  Their
+// output is held in chains of fixed-size blocks taken from a shared arena.
+typedef struct _jems_pool {
+  jems_pool_entry_t *entries;
+  size_t n_entries;
+  uint32_t free_head;  // (tag << 16) | index of the first free entry
+  jems_pool_block_t *blocks;
+  char *storage;       // n_blocks * block_size bytes
+  size_t n_blocks;
+  size_t block_size;
+  uint32_t free_block_head; // (tag << 16) | index of the first free block
+  size_t n_in_use;
+  size_t max_in_use;   // high-water mark of n_in_use
+  size_t n_blocks_in_use;
+  size_t max_blocks_in_use; // high-water mark of n_blocks_in_use
+  size_t max_length;   // high-water mark of output lengths at release
+} jems_pool_t;
+
+// One serialized fragment, see jems_cache_init().
+typedef struct {
+  uint32_t id;
+  uint32_t version;
+  uint64_t last_used;  // for LRU eviction, 0 marks an unused entry
+  size_t length;       // # of bytes in the fragment
+  size_t item_count;   // # of items the fragment adds to its level
+} jems_cache_entry_t;
+
+// How deeply cached fragments may be nested and still be recorded
+#define JEMS_CACHE_MAX_NESTING 4
+
+// A fragment being recorded, see jems_cached_begin().
+typedef struct {
+  uint32_t id;
+  uint32_t version;
+  bool is_recording;   // false if the fragment can't be cached
+  jems_mark_t start;   // position at the start of the fragment
+} jems_cache_pending_t;
+
+// A fixed-capacity cache of serialized fragments.
+typedef struct {
+  jems_cache_entry_t *entries;
+  size_t n_entries;
+  char *storage;       // n_entries * slot_size bytes
+  size_t slot_size;
+  uint64_t clock;      // incremented on every use of an entry
+  size_t depth;        // # of jems_cached_begin() misses awaiting end
+  jems_cache_pending_t pending[JEMS_CACHE_MAX_NESTING];
+} jems_cache_t;
+
 // *****************************************************************************
 // Public declarations
 
@@ -94,9 +214,314 @@ jems_t *jems_init(jems_t *jems,
 
 /**
  * @brief Reset to top level.
+ *
+ * If the jems object is buffered, the buffer is emptied.
  */
 jems_t *jems_reset(jems_t *jems);
 
+/**
+ * @brief Direct all subsequent output into buf rather than the writer.
+ *
+ * Bytes beyond buf_size are discarded, but are still counted by
+ * jems_buffer_length(), so a length greater than buf_size signals that the
+ * output was truncated.  No null terminator is written.  Any sink set by
+ * jems_set_sink() is detached.
+ *
+ * Example:
+ *
+ *     static char buf[512];
+ *     jems_init(&jems_obj, jems_levels, JEMS_MAX_LEVEL, NULL, 0);
+ *     jems_set_buffer(&jems_obj, buf, sizeof(buf));
+ */
+jems_t *jems_set_buffer(jems_t *jems, char *buf, size_t buf_size);
+
+/**
+ * @brief Direct all subsequent output into buf, passing it to sink one block at
+ * a time.
+ *
+ * Whenever buf fills, and on every call to jems_commit(), the buffered output
+ * is passed to sink in a single call and the buffer is emptied.  This avoids
+ * the per-character overhead of a jems_writer_fn when producing large
+ * documents: the sink can hand each block to fwrite(), write() or an
+ * asynchronous I/O queue.  Call jems_commit() when done to pass on the final
+ * partial block.  buf_size must be greater than zero.
+ *
+ * The sink may also be a pipeline stage such as a compressor: calling
+ * jems_commit() at the end of each record marks a point where it can flush
+ * (e.g. deflate() with Z_SYNC_FLUSH), since the sink's is_commit argument is
+ * true only for blocks that end at a commit.
+ *
+ * Note that marks and slots do not survive the buffer being passed to sink:
+ * see jems_rollback().
+ */
+jems_t *jems_set_sink(jems_t *jems, char *buf, size_t buf_size,
+                      jems_sink_fn sink, uintptr_t arg);
+
+/**
+ * @brief Return the number of bytes emitted into the buffer.
+ */
+size_t jems_buffer_length(jems_t *jems);
+
+/**
+ * @brief Return the total number of bytes passed to the writer or sink since
+ * the buffer was set up or the jems object was last reset.
+ */
+size_t jems_committed_length(jems_t *jems);
+
+/**
+ * @brief Save the current output position and level state in mark.
+ *
+ * A later call to jems_rollback() discards everything emitted since the mark,
+ * making it possible to speculatively serialize directly into the output
+ * buffer.  A mark remains valid until jems_commit() or jems_reset() is called,
+ * or until the object or array that was open at the time of the mark is
+ * closed.
+ */
+jems_t *jems_mark(jems_t *jems, jems_mark_t *mark);
+
+/**
+ * @brief Discard all output emitted since mark was taken.
+ *
+ * If the buffer has been passed on since the mark was taken (by jems_commit()
+ * or by a sink filling up), the output can no longer be recalled and this has
+ * no effect.  Compare mark->committed with jems_committed_length() to detect
+ * this case.
+ */
+jems_t *jems_rollback(jems_t *jems, const jems_mark_t *mark);
+
+/**
+ * @brief Pass the buffered output to the sink or writer and empty the buffer.
+ *
+ * If the jems object has neither, the buffered output is simply discarded.
+ * Only the first buf_size bytes are passed on: check jems_buffer_length()
+ * beforehand (and jems_rollback() as needed) to avoid committing truncated
+ * output.  Outstanding marks and slots become invalid.
+ */
+jems_t *jems_commit(jems_t *jems);
+
+/**
+ * @brief Initialize a table to hold the key:value hashes of a delta object.
+ *
+ * capacity should comfortably exceed the number of keys in the object: keys
+ * that don't fit in the table are always treated as changed.
+ */
+jems_delta_t *jems_delta_init(jems_delta_t *delta,
+                              jems_delta_entry_t *entries,
+                              size_t capacity);
+
+/**
+ * @brief Start an object that is emitted as an RFC 7396 JSON Merge Patch.
+ *
+ * Describe the complete object as usual with jems_key_xxx() calls.  Each
+ * key:value pair whose serialized value is identical to its last accepted
+ * emission (see jems_delta_accept()) is discarded, as is the whole object if
+ * nothing changed.  The jems object must be buffered, with room for the
+ * complete object, and keys that are no longer present must be emitted
+ * explicitly as null.
+ *
+ * Delta objects may be nested, each with its own jems_delta_t.  Use
+ * jems_key_delta_open() for a delta object that is the value of a key: when
+ * nothing changed, the key disappears along with the object.  A delta object
+ * opened with jems_delta_open() at a value position can't vanish without
+ * leaving its key behind, so it is emitted as {} (a no-op merge patch).
+ *
+ * Keys and values are compared by 64 bit hash, so in the (astronomically
+ * unlikely) event of a hash collision, a changed value would be discarded.
+ * A key:value pair that is truncated or passed on to a sink before it is
+ * complete can't be compared and is always emitted.
+ *
+ * Example:
+ *
+ *     static jems_delta_entry_t entries[400];
+ *     static jems_delta_t delta;
+ *     jems_delta_init(&delta, entries, 400);
+ *     ...
+ *     jems_delta_open(&jems_obj, &delta);
+ *     jems_key_integer(&jems_obj, "rssi", rssi);
+ *     ...
+ *     jems_delta_close(&jems_obj);
+ *     if (send_patch(...)) {
+ *       jems_delta_accept(&delta);
+ *     }
+ */
+jems_t *jems_delta_open(jems_t *jems, jems_delta_t *delta);
+
+/**
+ * @brief Emit a string key followed by an object emitted as a merge patch.
+ *
+ * If nothing in the object changed, neither the key nor the object is emitted.
+ */
+jems_t *jems_key_delta_open(jems_t *jems, const char *key, jems_delta_t *delta);
+
+/**
+ * @brief Like jems_key_delta_open(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_delta_open_n(jems_t *jems, const char *key, size_t key_len,
+                              jems_delta_t *delta);
+
+/**
+ * @brief End an object begun with jems_delta_open().
+ */
+jems_t *jems_delta_close(jems_t *jems);
+
+/**
+ * @brief Record the values emitted by the last delta object as delivered.
+ *
+ * Call this once the patch has been sent: subsequent patches are computed
+ * against the accepted values.  If the patch is instead discarded (truncated,
+ * abandoned by jems_reset() or not delivered), simply don't call this, and
+ * the next patch will include the same changes.
+ */
+jems_delta_t *jems_delta_accept(jems_delta_t *delta);
+
+/**
+ * @brief Return the number of key:value pairs emitted by the last delta object.
+ */
+size_t jems_delta_changed(jems_delta_t *delta);
+
+/**
+ * @brief Initialize a pool of n_entries buffered jems objects that share an
+ * arena of n_blocks blocks of block_size bytes.
+ *
+ * Entry i uses max_level elements of levels starting at levels[i * max_level],
+ * so levels must hold n_entries * max_level elements.  storage must hold
+ * n_blocks * block_size bytes.  Neither n_entries nor n_blocks may exceed
+ * 65535.
+ *
+ * Each jems object starts out with one block.  Whenever that fills, or at
+ * jems_commit(), the block is chained to the object's output and replaced by
+ * a fresh one from the arena, so memory is bounded by the arena rather than
+ * by the worst case of every object.  A delta object must fit in one block.
+ *
+ * Example:
+ *
+ *     #define N_WORKERS 16
+ *     #define N_BLOCKS 256
+ *     static jems_pool_entry_t entries[N_WORKERS];
+ *     static jems_level_t levels[N_WORKERS * JEMS_MAX_LEVEL];
+ *     static jems_pool_block_t blocks[N_BLOCKS];
+ *     static char storage[N_BLOCKS * 512];
+ *     static jems_pool_t pool;
+ *     jems_pool_init(&pool, entries, N_WORKERS, levels, JEMS_MAX_LEVEL,
+ *                    blocks, storage, N_BLOCKS, 512);
+ */
+jems_pool_t *jems_pool_init(jems_pool_t *pool,
+                            jems_pool_entry_t *entries,
+                            size_t n_entries,
+                            jems_level_t *levels,
+                            size_t max_level,
+                            jems_pool_block_t *blocks,
+                            char *storage,
+                            size_t n_blocks,
+                            size_t block_size);
+
+/**
+ * @brief Take a freshly reset jems object from the pool.
+ *
+ * The jems object is returned to the state set up by jems_pool_init(), with
+ * one empty block: any writer, sink or delta object set by its previous
+ * holder is discarded.  Don't change its buffer or sink.  Returns NULL if all
+ * entries or all blocks are in use.  Acquiring and releasing take constant
+ * time and, when compiled with gcc or clang for a target with lock-free
+ * compare-and-swap, are lock-free and safe to call from multiple threads.
+ */
+jems_t *jems_pool_acquire(jems_pool_t *pool);
+
+/**
+ * @brief Pass the output of a pooled jems object to sink, one block at a time.
+ *
+ * The final call has is_commit set.  If the arena ran out of blocks, only the
+ * output up to that point is passed on.  Returns the number of bytes passed.
+ */
+size_t jems_pool_output(jems_pool_t *pool, jems_t *jems, jems_sink_fn sink,
+                        uintptr_t arg);
+
+/**
+ * @brief Return true if the arena ran out of blocks for a pooled jems object.
+ */
+bool jems_pool_is_truncated(jems_pool_t *pool, jems_t *jems);
+
+/**
+ * @brief Return a jems object obtained from jems_pool_acquire(), along with
+ * all its blocks, to the pool.
+ */
+void jems_pool_release(jems_pool_t *pool, jems_t *jems);
+
+/**
+ * @brief Return the number of pooled jems objects currently in use.
+ */
+size_t jems_pool_in_use(jems_pool_t *pool);
+
+/**
+ * @brief Return the largest number of pooled jems objects in use at once.
+ */
+size_t jems_pool_max_in_use(jems_pool_t *pool);
+
+/**
+ * @brief Return the number of arena blocks currently in use.
+ */
+size_t jems_pool_blocks_in_use(jems_pool_t *pool);
+
+/**
+ * @brief Return the largest number of arena blocks in use at once.
+ */
+size_t jems_pool_max_blocks_in_use(jems_pool_t *pool);
+
+/**
+ * @brief Return the largest output length of any jems object at release,
+ * including any output lost when the arena ran out of blocks.
+ */
+size_t jems_pool_max_length(jems_pool_t *pool);
+
+/**
+ * @brief Initialize a cache of n_entries serialized fragments.
+ *
+ * Each fragment may be up to slot_size bytes long, stored in storage, which
+ * must hold n_entries * slot_size bytes.
+ */
+jems_cache_t *jems_cache_init(jems_cache_t *cache,
+                              jems_cache_entry_t *entries,
+                              size_t n_entries,
+                              char *storage,
+                              size_t slot_size);
+
+/**
+ * @brief Emit a cached fragment, or start recording one.
+ *
+ * If the cache holds a fragment for id at the given version, it is emitted in
+ * one block and true is returned.  Otherwise false is returned and the caller
+ * should emit the fragment as usual and then call jems_cached_end().  A
+ * fragment can be any sequence of values (or key:value pairs) at the current
+ * level, and should be replayed at a level of the same kind, with the same
+ * item count parity.
+ *
+ * Example:
+ *
+ *     if (!jems_cached_begin(&jems_obj, &cache, CONFIG_ID, config_version)) {
+ *       jems_key_object_open(&jems_obj, "config");
+ *       ...
+ *       jems_object_close(&jems_obj);
+ *       jems_cached_end(&jems_obj, &cache);
+ *     }
+ *
+ * Fragments may be nested, e.g. a cached capability list within a cached
+ * device configuration, but only the outermost JEMS_CACHE_MAX_NESTING levels
+ * are recorded.  Every call that returns false must be matched by a call to
+ * jems_cached_end().
+ *
+ * Recording requires a buffered jems object: the fragment is not cached (and
+ * nothing is evicted) if it was truncated, passed on to a sink, or is longer
+ * than slot_size.  Fragments directly within a delta object are never cached,
+ * since the delta object may discard parts of them.
+ */
+bool jems_cached_begin(jems_t *jems, jems_cache_t *cache, uint32_t id,
+                       uint32_t version);
+
+/**
+ * @brief Finish recording a fragment begun with jems_cached_begin().
+ */
+jems_t *jems_cached_end(jems_t *jems, jems_cache_t *cache);
+
 /**
  * @brief Start a JSON object, i.e. emit '{'
  */
@@ -135,11 +560,62 @@ jems_t *jems_integer(jems_t *jems, int64_t value);
  */
 jems_t *jems_string(jems_t *jems, const char *string);
 
+/**
+ * @brief Emit length bytes of string in JSON format, quoting as needed.
+ *
+ * string need not be null-terminated.
+ */
+jems_t *jems_string_n(jems_t *jems, const char *string, size_t length);
+
 /**
  * @brief Emit length bytes as a string in JSON format, quoting as needed.
  */
 jems_t *jems_bytes(jems_t *jems, const uint8_t *bytes, size_t length);
 
+/**
+ * @brief Start a JSON string whose contents are supplied in chunks.
+ *
+ * Call jems_string_append() any number of times to emit the contents, quoting
+ * as needed, then jems_string_end() to close the string.  Quoting is the same
+ * as for jems_string(): each byte outside of printable ASCII is escaped on its
+ * own as \u00XX, so multi-byte UTF-8 sequences are not preserved as such.
+ */
+jems_t *jems_string_begin(jems_t *jems);
+
+/**
+ * @brief Emit length bytes as part of a string begun with jems_string_begin().
+ */
+jems_t *jems_string_append(jems_t *jems, const char *string, size_t length);
+
+/**
+ * @brief End a string begun with jems_string_begin().
+ */
+jems_t *jems_string_end(jems_t *jems);
+
+/**
+ * @brief Emit length bytes as a base64 encoded JSON string.
+ */
+jems_t *jems_base64(jems_t *jems, const uint8_t *bytes, size_t length);
+
+/**
+ * @brief Start a base64 encoded JSON string whose contents are supplied in
+ * chunks.
+ *
+ * Call jems_base64_append() any number of times followed by jems_base64_end().
+ * Chunks need not be a multiple of three bytes long.
+ */
+jems_t *jems_base64_begin(jems_t *jems);
+
+/**
+ * @brief Encode length bytes as part of a string begun with jems_base64_begin().
+ */
+jems_t *jems_base64_append(jems_t *jems, const uint8_t *bytes, size_t length);
+
+/**
+ * @brief End a string begun with jems_base64_begin(), adding padding as needed.
+ */
+jems_t *jems_base64_end(jems_t *jems);
+
 /**
  * @brief Emit a boolean (true or false) in JSON format.
  */
@@ -165,16 +641,70 @@ jems_t *jems_null(jems_t *jems);
  */
 jems_t *jems_literal(jems_t *jems, const char *literal, size_t n_bytes);
 
+/**
+ * @brief Emit a fixed-point number in JSON format.
+ *
+ * The emitted value is value / 10^decimals, rendered with exactly `decimals`
+ * digits after the decimal point using integer arithmetic only.  For example,
+ * jems_fixed(jems, -1234, 2) emits -12.34.
+ */
+jems_t *jems_fixed(jems_t *jems, int64_t value, unsigned int decimals);
+
+/**
+ * @brief Emit an RFC-3339 (ISO-8601) UTC timestamp as a JSON string.
+ *
+ * seconds is the number of seconds since the Unix epoch and nanoseconds is the
+ * fractional part (0 to 999999999).  The fraction is emitted with 3, 6 or 9
+ * digits as needed, or omitted entirely when zero, e.g.:
+ *
+ *     "2022-03-14T15:09:26Z"
+ *     "2022-03-14T15:09:26.535Z"
+ *
+ * RFC-3339 only provides for the years 0000 to 9999: if the timestamp falls
+ * outside that range or nanoseconds is out of range, null is emitted instead.
+ */
+jems_t *jems_timestamp(jems_t *jems, int64_t seconds, uint32_t nanoseconds);
+
+/**
+ * @brief Emit an integer right-justified in a fixed-width, rewritable slot.
+ *
+ * The integer is padded on the left with spaces to width bytes (or to its
+ * natural width if that is larger), and slot is set to refer to those bytes
+ * in the output buffer so that jems_slot_set_integer() can later update the
+ * value in place.  slot->ptr is NULL if the jems object is not buffered or if
+ * the slot did not fit in the buffer.
+ */
+jems_t *jems_slot_integer(jems_t *jems, jems_slot_t *slot, int64_t value,
+                          size_t width);
+
+/**
+ * @brief Rewrite the integer held in a slot.
+ *
+ * Returns false (leaving the slot unchanged) if the slot is not valid or value
+ * does not fit in the slot's width.
+ */
+bool jems_slot_set_integer(jems_slot_t *slot, int64_t value);
+
 /**
  * @brief Emit a string key followed by an open object.
  */
 jems_t *jems_key_object_open(jems_t *jems, const char *key);
 
+/**
+ * @brief Like jems_key_object_open(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_object_open_n(jems_t *jems, const char *key, size_t key_len);
+
 /**
  * @brief Emit a string key followed by an open array.
  */
 jems_t *jems_key_array_open(jems_t *jems, const char *key);
 
+/**
+ * @brief Like jems_key_array_open(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_array_open_n(jems_t *jems, const char *key, size_t key_len);
+
 /**
  * @brief Emit a string key followed by a number.
  *
@@ -183,46 +713,151 @@ jems_t *jems_key_array_open(jems_t *jems, const char *key);
  */
 jems_t *jems_key_number(jems_t *jems, const char *key, double value);
 
+/**
+ * @brief Like jems_key_number(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_number_n(jems_t *jems, const char *key, size_t key_len, double value);
+
 /**
  * @brief Emit a string key followed by an integer.
  */
 jems_t *jems_key_integer(jems_t *jems, const char *key, int64_t value);
 
+/**
+ * @brief Like jems_key_integer(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_integer_n(jems_t *jems, const char *key, size_t key_len, int64_t value);
+
 /**
  * @brief Emit a string key followed by a string, quoting as needed.
  */
 jems_t *jems_key_string(jems_t *jems, const char *key, const char *string);
 
+/**
+ * @brief Like jems_key_string(), but with explicit key and string lengths.
+ */
+jems_t *jems_key_string_n(jems_t *jems, const char *key, size_t key_len, const char *string, size_t length);
+
 /**
  * @brief Emit a string key followed by a string of bytes in JSON string format.
  */
 jems_t *jems_key_bytes(jems_t *jems, const char *key, const uint8_t *bytes, size_t length);
 
+/**
+ * @brief Like jems_key_bytes(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_bytes_n(jems_t *jems, const char *key, size_t key_len, const uint8_t *bytes, size_t length);
+
+/**
+ * @brief Emit a string key followed by the start of a chunked string.
+ */
+jems_t *jems_key_string_begin(jems_t *jems, const char *key);
+
+/**
+ * @brief Like jems_key_string_begin(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_string_begin_n(jems_t *jems, const char *key, size_t key_len);
+
+/**
+ * @brief Emit a string key followed by a base64 encoded string of bytes.
+ */
+jems_t *jems_key_base64(jems_t *jems, const char *key, const uint8_t *bytes, size_t length);
+
+/**
+ * @brief Like jems_key_base64(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_base64_n(jems_t *jems, const char *key, size_t key_len, const uint8_t *bytes, size_t length);
+
+/**
+ * @brief Emit a string key followed by the start of a chunked base64 string.
+ */
+jems_t *jems_key_base64_begin(jems_t *jems, const char *key);
+
+/**
+ * @brief Like jems_key_base64_begin(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_base64_begin_n(jems_t *jems, const char *key, size_t key_len);
+
 /**
  * @brief Emit a string key followed by boolean (true or false).
  */
 jems_t *jems_key_bool(jems_t *jems, const char *key, bool boolean);
 
+/**
+ * @brief Like jems_key_bool(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_bool_n(jems_t *jems, const char *key, size_t key_len, bool boolean);
+
 /**
  * @brief Emit a string key followed by a JSON true value.
  */
 jems_t *jems_key_true(jems_t *jems, const char *key);
 
+/**
+ * @brief Like jems_key_true(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_true_n(jems_t *jems, const char *key, size_t key_len);
+
 /**
  * @brief Emit a string key followed by a JSON false value.
  */
 jems_t *jems_key_false(jems_t *jems, const char *key);
 
+/**
+ * @brief Like jems_key_false(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_false_n(jems_t *jems, const char *key, size_t key_len);
+
 /**
  * @brief Emit a string key followed by a JSON null value.
  */
 jems_t *jems_key_null(jems_t *jems, const char *key);
 
+/**
+ * @brief Like jems_key_null(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_null_n(jems_t *jems, const char *key, size_t key_len);
+
 /**
  * @brief Emit a string key followed by a literal string verbatim (no quotes)
  */
 jems_t *jems_key_literal(jems_t *jems, const char *key, const char *literal, size_t n_bytes);
 
+/**
+ * @brief Like jems_key_literal(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_literal_n(jems_t *jems, const char *key, size_t key_len, const char *literal, size_t n_bytes);
+
+/**
+ * @brief Emit a string key followed by a fixed-point number.
+ */
+jems_t *jems_key_fixed(jems_t *jems, const char *key, int64_t value, unsigned int decimals);
+
+/**
+ * @brief Like jems_key_fixed(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_fixed_n(jems_t *jems, const char *key, size_t key_len, int64_t value, unsigned int decimals);
+
+/**
+ * @brief Emit a string key followed by an RFC-3339 UTC timestamp.
+ */
+jems_t *jems_key_timestamp(jems_t *jems, const char *key, int64_t seconds, uint32_t nanoseconds);
+
+/**
+ * @brief Like jems_key_timestamp(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_timestamp_n(jems_t *jems, const char *key, size_t key_len, int64_t seconds, uint32_t nanoseconds);
+
+/**
+ * @brief Emit a string key followed by an integer in a rewritable slot.
+ */
+jems_t *jems_key_slot_integer(jems_t *jems, const char *key, jems_slot_t *slot, int64_t value, size_t width);
+
+/**
+ * @brief Like jems_key_slot_integer(), but with a key of key_len bytes.
+ */
+jems_t *jems_key_slot_integer_n(jems_t *jems, const char *key, size_t key_len, jems_slot_t *slot, int64_t value, size_t width);
+
 /**
  * @brief Return the current expression depth.
  */
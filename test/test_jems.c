@@ -90,6 +90,12 @@ static void test_reset(void);
  */
 static void test_writer(char c, uintptr_t arg);
 
+/**
+ * @brief Append a block of characters to the test string.
+ */
+static void test_sink(const char *bytes, size_t n_bytes, bool is_commit,
+                      uintptr_t arg);
+
 /**
  * @brief Return true if the test string equals the expected string.
  */
@@ -182,6 +188,68 @@ int main(void) {
     jems_literal(&s_jems, PI_100, strlen(PI_100));
     ASSERT(test_result(PI_100));
 
+    test_reset();
+    jems_integer(&s_jems, INT64_MIN);
+    ASSERT(test_result("-9223372036854775808"));
+
+    test_reset();
+    ASSERT(jems_fixed(&s_jems, 12345, 3) == &s_jems);
+    ASSERT(jems_item_count(&s_jems) == 1);
+    ASSERT(test_result("12.345"));
+
+    test_reset();
+    jems_fixed(&s_jems, -5, 2);
+    ASSERT(test_result("-0.05"));
+
+    test_reset();
+    jems_fixed(&s_jems, 42, 0);
+    ASSERT(test_result("42"));
+
+    test_reset();
+    jems_fixed(&s_jems, -5, 25);
+    ASSERT(test_result("-0.0000000000000000000000005"));
+
+    test_reset();
+    jems_fixed(&s_jems, INT64_MAX, 20);
+    ASSERT(test_result("0.09223372036854775807"));
+
+    test_reset();
+    ASSERT(jems_timestamp(&s_jems, 0, 0) == &s_jems);
+    ASSERT(jems_item_count(&s_jems) == 1);
+    ASSERT(test_result("\"1970-01-01T00:00:00Z\""));
+
+    test_reset();
+    jems_timestamp(&s_jems, 1647270566, 535000000);
+    ASSERT(test_result("\"2022-03-14T15:09:26.535Z\""));
+
+    test_reset();
+    jems_timestamp(&s_jems, 951782400, 123456789);
+    ASSERT(test_result("\"2000-02-29T00:00:00.123456789Z\""));
+
+    test_reset();
+    jems_timestamp(&s_jems, -1, 1000);
+    ASSERT(test_result("\"1969-12-31T23:59:59.000001Z\""));
+
+    test_reset();
+    jems_timestamp(&s_jems, 253402300799, 0);
+    ASSERT(test_result("\"9999-12-31T23:59:59Z\""));
+
+    test_reset();
+    jems_timestamp(&s_jems, -62167219200, 0);
+    ASSERT(test_result("\"0000-01-01T00:00:00Z\""));
+
+    test_reset();
+    jems_timestamp(&s_jems, 253402300800, 0);
+    ASSERT(test_result("null"));
+
+    test_reset();
+    jems_timestamp(&s_jems, -62167219201, 0);
+    ASSERT(test_result("null"));
+
+    test_reset();
+    jems_timestamp(&s_jems, 0, 1500000000);
+    ASSERT(test_result("null"));
+
     // Test string escaping (tip of the hat to Latex95)
     test_reset();
     jems_string(&s_jems, "say \"hey\"!");
@@ -210,7 +278,57 @@ int main(void) {
         ASSERT(test_result("\"\\u0000\\u0001 ~\\u007f\\u0080\""));
     } while (false);
 
+    // length-explicit strings
+    test_reset();
+    ASSERT(jems_string_n(&s_jems, "woof woof", 4) == &s_jems);
+    ASSERT(jems_item_count(&s_jems) == 1);
+    ASSERT(test_result("\"woof\""));
+
+    test_reset();
+    jems_string_n(&s_jems, "a\0\"b", 4);
+    ASSERT(test_result("\"a\\u0000\\\"b\""));
+
+    // chunked strings
+    test_reset();
+    ASSERT(jems_string_begin(&s_jems) == &s_jems);
+    ASSERT(jems_string_append(&s_jems, "say \"h", 6) == &s_jems);
+    ASSERT(jems_string_append(&s_jems, "ey\"!", 4) == &s_jems);
+    ASSERT(jems_string_end(&s_jems) == &s_jems);
+    ASSERT(jems_item_count(&s_jems) == 1);
+    ASSERT(test_result("\"say \\\"hey\\\"!\""));
+
+    // base64
+    test_reset();
+    ASSERT(jems_base64(&s_jems, (uint8_t *)"foobar", 6) == &s_jems);
+    ASSERT(jems_item_count(&s_jems) == 1);
+    ASSERT(test_result("\"Zm9vYmFy\""));
+
+    test_reset();
+    jems_base64(&s_jems, (uint8_t *)"fooba", 5);
+    ASSERT(test_result("\"Zm9vYmE=\""));
+
+    test_reset();
+    jems_base64(&s_jems, (uint8_t *)"f", 1);
+    ASSERT(test_result("\"Zg==\""));
+
+    test_reset();
+    ASSERT(jems_base64_begin(&s_jems) == &s_jems);
+    ASSERT(jems_base64_append(&s_jems, (uint8_t *)"f", 1) == &s_jems);
+    ASSERT(jems_base64_append(&s_jems, (uint8_t *)"ooba", 4) == &s_jems);
+    ASSERT(jems_base64_append(&s_jems, (uint8_t *)"r", 1) == &s_jems);
+    ASSERT(jems_base64_end(&s_jems) == &s_jems);
+    ASSERT(test_result("\"Zm9vYmFy\""));
+
     // key:value pairs
+    test_reset();
+    jems_object_open(&s_jems);
+    jems_key_string_n(&s_jems, "keyring", 3, "value!", 5);
+    jems_key_integer_n(&s_jems, "numbers", 3, 42);
+    jems_key_object_open_n(&s_jems, "object", 3);
+    jems_object_close(&s_jems);
+    jems_object_close(&s_jems);
+    ASSERT(test_result("{\"key\":\"value\",\"num\":42,\"obj\":{}}"));
+
     test_reset();
     jems_object_open(&s_jems);
     jems_key_object_open(&s_jems, "key");
@@ -279,6 +397,25 @@ int main(void) {
     jems_object_close(&s_jems);
     ASSERT(test_result("{\"pi\":" PI_100 "}"));
 
+    test_reset();
+    jems_object_open(&s_jems);
+    jems_key_string_begin(&s_jems, "log");
+    jems_string_append(&s_jems, "a", 1);
+    jems_string_end(&s_jems);
+    jems_key_base64(&s_jems, "raw", (uint8_t *)"foo", 3);
+    jems_key_base64_begin(&s_jems, "more");
+    jems_base64_append(&s_jems, (uint8_t *)"fo", 2);
+    jems_base64_end(&s_jems);
+    jems_object_close(&s_jems);
+    ASSERT(test_result("{\"log\":\"a\",\"raw\":\"Zm9v\",\"more\":\"Zm8=\"}"));
+
+    test_reset();
+    jems_object_open(&s_jems);
+    jems_key_fixed(&s_jems, "mv", 3300, 3);
+    jems_key_timestamp(&s_jems, "at", 0, 0);
+    jems_object_close(&s_jems);
+    ASSERT(test_result("{\"mv\":3.300,\"at\":\"1970-01-01T00:00:00Z\"}"));
+
     test_reset();
     ASSERT(jems_curr_level(&s_jems) == 0);
     ASSERT(jems_item_count(&s_jems) == 0);
@@ -314,6 +451,431 @@ int main(void) {
     ASSERT(jems_item_count(&s_jems) == 1);
     ASSERT(test_result("{\"colors\":[1,2,3],\"valid\":true}"));
 
+    // buffered output and rewritable slots
+    do {
+        char buf[40];
+        jems_slot_t count;
+        jems_slot_t bogus;
+        jems_init(&s_jems, s_levels, MAX_LEVEL, NULL, 0);
+        ASSERT(jems_set_buffer(&s_jems, buf, sizeof(buf)) == &s_jems);
+        jems_object_open(&s_jems);
+        jems_key_slot_integer(&s_jems, "count", &count, 7, 5);
+        jems_key_slot_integer(&s_jems, "wide", &bogus, 123456, 2);
+        jems_object_close(&s_jems);
+        ASSERT(jems_buffer_length(&s_jems) == 29);
+        ASSERT(memcmp(buf, "{\"count\":    7,\"wide\":123456}", 29) == 0);
+        ASSERT(jems_slot_set_integer(&count, -1234));
+        ASSERT(!jems_slot_set_integer(&count, 123456));
+        ASSERT(memcmp(buf, "{\"count\":-1234,\"wide\":123456}", 29) == 0);
+        ASSERT(bogus.width == 6);
+
+        // overflow is counted but not written
+        jems_reset(jems_set_buffer(&s_jems, buf, 4));
+        jems_slot_integer(&s_jems, &bogus, 12345, 0);
+        ASSERT(jems_buffer_length(&s_jems) == 5);
+        ASSERT(bogus.ptr == NULL);
+        ASSERT(!jems_slot_set_integer(&bogus, 1));
+        ASSERT(memcmp(buf, "1234", 4) == 0);
+    } while (false);
+
+    // checkpoint and rollback
+    do {
+        char buf[16];
+        jems_mark_t mark;
+        test_reset();
+        jems_set_buffer(&s_jems, buf, sizeof(buf));
+        jems_array_open(&s_jems);
+        jems_integer(&s_jems, 1);
+        ASSERT(jems_mark(&s_jems, &mark) == &s_jems);
+        jems_object_open(&s_jems);
+        jems_key_string(&s_jems, "too", "long to fit");
+        ASSERT(jems_buffer_length(&s_jems) > sizeof(buf));
+        ASSERT(jems_rollback(&s_jems, &mark) == &s_jems);
+        ASSERT(jems_curr_level(&s_jems) == 1);
+        ASSERT(jems_item_count(&s_jems) == 1);
+        jems_integer(&s_jems, 2);
+        jems_array_close(&s_jems);
+        ASSERT(jems_buffer_length(&s_jems) == 5);
+        ASSERT(test_result(""));
+        ASSERT(jems_commit(&s_jems) == &s_jems);
+        ASSERT(jems_buffer_length(&s_jems) == 0);
+        ASSERT(test_result("[1,2]"));
+    } while (false);
+
+    // delta (merge patch) objects
+    do {
+        char buf[64];
+        jems_delta_entry_t entries[8];
+        jems_delta_t delta;
+        int b_values[] = {1, 1, 2, 2};
+        const char *c_values[] = {"x", "x", "x", "y"};
+        const char *expected[] = {
+            "{\"a\":1,\"b\":{\"c\":1},\"d\":\"x\"}",
+            "",
+            "{\"b\":{\"c\":2}}",
+            "{\"d\":\"y\"}",
+        };
+        ASSERT(jems_delta_init(&delta, entries, 8) == &delta);
+        for (int i = 0; i < 4; i++) {
+            test_reset();
+            jems_set_buffer(&s_jems, buf, sizeof(buf));
+            ASSERT(jems_delta_open(&s_jems, &delta) == &s_jems);
+            jems_key_integer(&s_jems, "a", 1);
+            jems_key_object_open(&s_jems, "b");
+            jems_key_integer(&s_jems, "c", b_values[i]);
+            jems_object_close(&s_jems);
+            jems_key_string(&s_jems, "d", c_values[i]);
+            ASSERT(jems_delta_close(&s_jems) == &s_jems);
+            ASSERT(jems_curr_level(&s_jems) == 0);
+            ASSERT(jems_item_count(&s_jems) == (i == 1 ? 0 : 1));
+            ASSERT(jems_delta_changed(&delta) == (i == 0 ? 3 : i == 1 ? 0 : 1));
+            jems_commit(&s_jems);
+            ASSERT(test_result(expected[i]));
+            ASSERT(jems_delta_accept(&delta) == &delta);
+        }
+
+        // with a sink, pairs that span a flush are always emitted
+        char small[6];
+        int n_calls = 0;
+        test_reset();
+        jems_set_sink(&s_jems, small, sizeof(small), test_sink,
+                      (uintptr_t)&n_calls);
+        jems_delta_open(&s_jems, &delta);
+        jems_key_string(&s_jems, "d", "y"); // unchanged, but spans a flush
+        jems_delta_close(&s_jems);
+        jems_commit(&s_jems);
+        ASSERT(jems_delta_changed(&delta) == 1);
+        ASSERT(test_result("{\"d\":\"y\"}"));
+
+        // reset abandons an open delta object
+        test_reset();
+        jems_set_buffer(&s_jems, buf, sizeof(buf));
+        jems_delta_open(&s_jems, &delta);
+        jems_reset(&s_jems);
+        ASSERT(s_jems.delta == NULL);
+
+        // changes are resent until accepted
+        for (int i = 0; i < 3; i++) {
+            test_reset();
+            jems_set_buffer(&s_jems, buf, sizeof(buf));
+            jems_delta_open(&s_jems, &delta);
+            jems_key_string(&s_jems, "d", "z");
+            jems_delta_close(&s_jems);
+            jems_commit(&s_jems);
+            ASSERT(test_result(i < 2 ? "{\"d\":\"z\"}" : ""));
+            if (i == 1) {
+                jems_delta_accept(&delta);
+            }
+        }
+
+        // nested delta objects, with the inner one the value of a key
+        jems_delta_entry_t outer_entries[8];
+        jems_delta_entry_t inner_entries[8];
+        jems_delta_t outer;
+        jems_delta_t inner;
+        int c_ints[] = {1, 1, 2, 2};
+        int a_ints[] = {1, 1, 1, 2};
+        const char *nested[] = {
+            "{\"sub\":{\"c\":1},\"a\":1}",
+            "",
+            "{\"sub\":{\"c\":2}}",
+            "{\"a\":2}",
+        };
+        jems_delta_init(&outer, outer_entries, 8);
+        jems_delta_init(&inner, inner_entries, 8);
+        for (int i = 0; i < 4; i++) {
+            test_reset();
+            jems_set_buffer(&s_jems, buf, sizeof(buf));
+            jems_delta_open(&s_jems, &outer);
+            ASSERT(jems_key_delta_open(&s_jems, "sub", &inner) == &s_jems);
+            jems_key_integer(&s_jems, "c", c_ints[i]);
+            jems_delta_close(&s_jems);
+            ASSERT(s_jems.delta == &outer);
+            jems_key_integer(&s_jems, "a", a_ints[i]);
+            jems_delta_close(&s_jems);
+            ASSERT(s_jems.delta == NULL);
+            ASSERT(jems_curr_level(&s_jems) == 0);
+            jems_commit(&s_jems);
+            ASSERT(test_result(nested[i]));
+            jems_delta_accept(&outer);
+            jems_delta_accept(&inner);
+        }
+
+        // an unchanged keyed delta object within an ordinary object vanishes
+        jems_delta_init(&inner, inner_entries, 8);
+        for (int i = 0; i < 2; i++) {
+            test_reset();
+            jems_set_buffer(&s_jems, buf, sizeof(buf));
+            jems_object_open(&s_jems);
+            jems_key_delta_open_n(&s_jems, "statex", 5, &inner);
+            jems_key_integer(&s_jems, "c", 1);
+            jems_delta_close(&s_jems);
+            jems_key_integer(&s_jems, "ts", i);
+            jems_object_close(&s_jems);
+            jems_commit(&s_jems);
+            ASSERT(test_result(i == 0 ? "{\"state\":{\"c\":1},\"ts\":0}"
+                                      : "{\"ts\":1}"));
+            jems_delta_accept(&inner);
+        }
+
+        // ... but one opened at a value position is emitted as {}
+        test_reset();
+        jems_set_buffer(&s_jems, buf, sizeof(buf));
+        jems_object_open(&s_jems);
+        jems_string(&s_jems, "state");
+        jems_delta_open(&s_jems, &inner);
+        jems_key_integer(&s_jems, "c", 1);
+        jems_delta_close(&s_jems);
+        jems_key_integer(&s_jems, "ts", 2);
+        jems_object_close(&s_jems);
+        jems_commit(&s_jems);
+        ASSERT(test_result("{\"state\":{},\"ts\":2}"));
+
+        // ... including within another delta object
+        jems_delta_init(&outer, outer_entries, 8);
+        jems_delta_init(&inner, inner_entries, 8);
+        for (int i = 0; i < 2; i++) {
+            test_reset();
+            jems_set_buffer(&s_jems, buf, sizeof(buf));
+            jems_delta_open(&s_jems, &outer);
+            jems_string(&s_jems, "sub");
+            jems_delta_open(&s_jems, &inner);
+            jems_key_integer(&s_jems, "c", 1);
+            jems_delta_close(&s_jems);
+            jems_delta_close(&s_jems);
+            jems_commit(&s_jems);
+            ASSERT(test_result(i == 0 ? "{\"sub\":{\"c\":1}}"
+                                      : "{\"sub\":{}}"));
+            jems_delta_accept(&outer);
+            jems_delta_accept(&inner);
+        }
+    } while (false);
+
+    // pooled jems objects
+    do {
+        static jems_pool_entry_t entries[2];
+        static jems_level_t levels[2 * MAX_LEVEL];
+        static jems_pool_block_t blocks[4];
+        static char storage[4 * 8];
+        jems_pool_t pool;
+        int n_calls;
+        ASSERT(jems_pool_init(&pool, entries, 2, levels, MAX_LEVEL, blocks,
+                              storage, 4, 8) == &pool);
+        jems_t *a = jems_pool_acquire(&pool);
+        jems_t *b = jems_pool_acquire(&pool);
+        ASSERT(a != NULL);
+        ASSERT(b != NULL);
+        ASSERT(a != b);
+        ASSERT(jems_pool_acquire(&pool) == NULL);
+        ASSERT(jems_pool_in_use(&pool) == 2);
+        ASSERT(jems_pool_blocks_in_use(&pool) == 2);
+
+        // output grows by chaining blocks, at commits and when a block fills
+        jems_array_open(a);
+        jems_integer(a, 100);
+        jems_commit(a);
+        jems_integer(a, 200);
+        jems_integer(a, 300);
+        jems_array_close(a);
+        ASSERT(jems_pool_blocks_in_use(&pool) == 4);
+        test_reset();
+        n_calls = 0;
+        ASSERT(jems_pool_output(&pool, a, test_sink, (uintptr_t)&n_calls) ==
+               13);
+        ASSERT(n_calls == 102);
+        ASSERT(test_result("[100,200,300]"));
+        ASSERT(!jems_pool_is_truncated(&pool, a));
+
+        // the arena is exhausted
+        jems_string(b, "abcdefghij");
+        ASSERT(jems_pool_is_truncated(&pool, b));
+        test_reset();
+        n_calls = 0;
+        ASSERT(jems_pool_output(&pool, b, test_sink, (uintptr_t)&n_calls) ==
+               0);
+        ASSERT(n_calls == 100);
+        ASSERT(test_result(""));
+        jems_pool_release(&pool, b);
+        ASSERT(jems_pool_in_use(&pool) == 1);
+        ASSERT(jems_pool_blocks_in_use(&pool) == 3);
+        jems_pool_release(&pool, a);
+        ASSERT(jems_pool_in_use(&pool) == 0);
+        ASSERT(jems_pool_blocks_in_use(&pool) == 0);
+
+        // one jems object may use the whole arena
+        a = jems_pool_acquire(&pool);
+        ASSERT(a != NULL);
+        ASSERT(jems_buffer_length(a) == 0);
+        ASSERT(jems_committed_length(a) == 0);
+        ASSERT(jems_curr_level(a) == 0);
+        jems_string(a, "abcdefghijklmnopqrstuvwxyz");
+        ASSERT(jems_pool_blocks_in_use(&pool) == 4);
+        ASSERT(jems_pool_acquire(&pool) == NULL);
+        ASSERT(jems_pool_in_use(&pool) == 1);
+        test_reset();
+        n_calls = 0;
+        jems_pool_output(&pool, a, test_sink, (uintptr_t)&n_calls);
+        ASSERT(test_result("\"abcdefghijklmnopqrstuvwxyz\""));
+
+        jems_pool_release(&pool, a);
+
+        // changes made by one holder don't leak to the next
+        a = jems_pool_acquire(&pool);
+        char other[4];
+        jems_set_sink(a, other, sizeof(other), test_sink,
+                      (uintptr_t)&n_calls);
+        jems_pool_release(&pool, a);
+        a = jems_pool_acquire(&pool);
+        ASSERT(a->sink != test_sink);
+        ASSERT(a->buf >= storage && a->buf < storage + sizeof(storage));
+        ASSERT(a->buf_size == 8);
+        jems_pool_release(&pool, a);
+        ASSERT(jems_pool_in_use(&pool) == 0);
+        ASSERT(jems_pool_blocks_in_use(&pool) == 0);
+        ASSERT(jems_pool_max_in_use(&pool) == 2);
+        ASSERT(jems_pool_max_blocks_in_use(&pool) == 4);
+        ASSERT(jems_pool_max_length(&pool) == 28);
+    } while (false);
+
+    // fragment cache
+    do {
+        char buf[64];
+        jems_cache_entry_t entries[2];
+        static char storage[2 * 32];
+        jems_cache_t cache;
+        ASSERT(jems_cache_init(&cache, entries, 2, storage, 32) == &cache);
+        for (int i = 0; i < 2; i++) {
+            test_reset();
+            jems_set_buffer(&s_jems, buf, sizeof(buf));
+            jems_object_open(&s_jems);
+            jems_key_integer(&s_jems, "n", i);
+            ASSERT(jems_cached_begin(&s_jems, &cache, 1, 7) == (i == 1));
+            if (i == 0) {
+                jems_key_object_open(&s_jems, "cfg");
+                jems_key_true(&s_jems, "on");
+                jems_object_close(&s_jems);
+                ASSERT(jems_cached_end(&s_jems, &cache) == &s_jems);
+            }
+            ASSERT(jems_item_count(&s_jems) == 4);
+            jems_key_null(&s_jems, "x");
+            jems_object_close(&s_jems);
+            jems_commit(&s_jems);
+            ASSERT(test_result(i == 0 ? "{\"n\":0,\"cfg\":{\"on\":true},\"x\":null}"
+                                      : "{\"n\":1,\"cfg\":{\"on\":true},\"x\":null}"));
+        }
+
+        // cached values spliced into an array, with LRU eviction
+        test_reset();
+        jems_set_buffer(&s_jems, buf, sizeof(buf));
+        jems_array_open(&s_jems);
+        ASSERT(!jems_cached_begin(&s_jems, &cache, 2, 1));
+        jems_string(&s_jems, "two");
+        jems_cached_end(&s_jems, &cache);
+        ASSERT(jems_cached_begin(&s_jems, &cache, 2, 1));
+        ASSERT(!jems_cached_begin(&s_jems, &cache, 3, 1)); // evicts id 1
+        jems_integer(&s_jems, 3);
+        jems_cached_end(&s_jems, &cache);
+        ASSERT(!jems_cached_begin(&s_jems, &cache, 1, 7)); // evicts id 2
+        jems_cached_end(&s_jems, &cache);
+        ASSERT(jems_cached_begin(&s_jems, &cache, 1, 7)); // empty fragment
+        ASSERT(!jems_cached_begin(&s_jems, &cache, 3, 2)); // stale version
+        jems_integer(&s_jems, 4);
+        jems_cached_end(&s_jems, &cache);
+        ASSERT(jems_cached_begin(&s_jems, &cache, 3, 2));
+        ASSERT(jems_item_count(&s_jems) == 5);
+        jems_array_close(&s_jems);
+        jems_commit(&s_jems);
+        ASSERT(test_result("[\"two\",\"two\",3,4,4]"));
+
+        // nested fragments; a failed recording evicts nothing
+        jems_cache_init(&cache, entries, 2, storage, 32);
+        for (int i = 0; i < 3; i++) {
+            test_reset();
+            jems_set_buffer(&s_jems, buf, sizeof(buf));
+            jems_array_open(&s_jems);
+            if (!jems_cached_begin(&s_jems, &cache, 1, 1)) {
+                ASSERT(i == 0);
+                jems_array_open(&s_jems);
+                if (!jems_cached_begin(&s_jems, &cache, 2, 1)) {
+                    ASSERT(i == 0);
+                    jems_integer(&s_jems, 22);
+                    jems_cached_end(&s_jems, &cache);
+                }
+                jems_array_close(&s_jems);
+                jems_cached_end(&s_jems, &cache);
+            }
+            if (!jems_cached_begin(&s_jems, &cache, 3, 1)) {
+                jems_string(&s_jems, "this is too long for a slot: 32+");
+                jems_cached_end(&s_jems, &cache);
+            }
+            jems_array_close(&s_jems);
+            jems_commit(&s_jems);
+            ASSERT(test_result("[[22],\"this is too long for a slot: 32+\"]"));
+        }
+        ASSERT(jems_cached_begin(&s_jems, &cache, 2, 1));
+
+        // no caching directly within a delta object
+        jems_delta_entry_t d_entries[4];
+        jems_delta_t delta;
+        jems_delta_init(&delta, d_entries, 4);
+        for (int i = 0; i < 2; i++) {
+            test_reset();
+            jems_set_buffer(&s_jems, buf, sizeof(buf));
+            jems_delta_open(&s_jems, &delta);
+            jems_key_integer(&s_jems, "a", i);
+            ASSERT(!jems_cached_begin(&s_jems, &cache, 4, 1));
+            jems_key_integer(&s_jems, "b", 1);
+            jems_cached_end(&s_jems, &cache);
+            jems_delta_close(&s_jems);
+            jems_commit(&s_jems);
+            ASSERT(test_result(i == 0 ? "{\"a\":0,\"b\":1}" : "{\"a\":1}"));
+            jems_delta_accept(&delta);
+        }
+    } while (false);
+
+    // block sink
+    do {
+        char buf[4];
+        int n_calls = 0;
+        test_reset();
+        ASSERT(jems_set_sink(&s_jems, buf, sizeof(buf), test_sink,
+                             (uintptr_t)&n_calls) == &s_jems);
+        jems_array_open(&s_jems);
+        jems_integer(&s_jems, 1);
+        jems_string(&s_jems, "abcdefghij");
+        jems_array_close(&s_jems);
+        ASSERT(n_calls == 3);
+        ASSERT(jems_buffer_length(&s_jems) == 4);
+        jems_commit(&s_jems);
+        ASSERT(n_calls == 103);
+        ASSERT(jems_committed_length(&s_jems) == 16);
+        ASSERT(test_result("[1,\"abcdefghij\"]"));
+
+        // marks don't survive passing the buffer to the sink
+        jems_mark_t mark;
+        test_reset();
+        jems_set_sink(&s_jems, buf, sizeof(buf), test_sink,
+                      (uintptr_t)&n_calls);
+        jems_array_open(&s_jems);
+        jems_mark(&s_jems, &mark);
+        jems_integer(&s_jems, 12345);
+        ASSERT(jems_committed_length(&s_jems) != mark.committed);
+        jems_rollback(&s_jems, &mark);
+        jems_array_close(&s_jems);
+        jems_commit(&s_jems);
+        ASSERT(test_result("[12345]"));
+
+        // jems_set_buffer() detaches the sink
+        test_reset();
+        jems_set_sink(&s_jems, buf, sizeof(buf), test_sink,
+                      (uintptr_t)&n_calls);
+        jems_set_buffer(&s_jems, buf, sizeof(buf));
+        n_calls = 0;
+        jems_string(&s_jems, "abcdef");
+        ASSERT(n_calls == 0);
+        ASSERT(jems_buffer_length(&s_jems) == 8);
+    } while (false);
+
     printf("\n... Finished test_jems\n");
 }
 
@@ -338,6 +900,14 @@ static void test_writer(char c, uintptr_t arg) {
     }
 }
 
+static void test_sink(const char *bytes, size_t n_bytes, bool is_commit,
+                      uintptr_t arg) {
+    *(int *)arg += is_commit ? 100 : 1; // count calls
+    for (size_t i = 0; i < n_bytes; i++) {
+        test_writer(bytes[i], 0);
+    }
+}
+
 static bool test_result(const char *expected) {
     s_test_string[s_test_idx] = '\0';
     printf("\nrendered %s", s_test_string);